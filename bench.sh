@@ -0,0 +1,128 @@
+#!/bin/bash
+# Simulator throughput benchmark.
+# Checks the simulator against the golden results in outputs/, then runs it
+# on synthetic traces of every pattern and size and reports accesses/second,
+# ns per access and peak RSS per phase. Results go to bench_output.txt and are
+# compared with a saved baseline; a slowdown beyond the tolerance fails the run.
+#
+#   BENCH_SIZES     total accesses per run (default "1K 10K 100K 1M", up to 1G)
+#   BENCH_PATTERNS  patterns to run (default: all)
+#   BENCH_WRITES    percentage of writes (default 30)
+#   BENCH_SHARING   number of cores sharing data (default 2)
+#   BENCH_STREAM_AT runs of at least this many accesses stream their traces
+#                   with -S instead of loading them (default 10M)
+#   BENCH_BASELINE  results to compare against (default bench_baseline.txt)
+#   BENCH_TOLERANCE allowed ns/access slowdown in percent (default 10)
+#   BENCH_MIN_MS    only compare runs whose baseline simulate phase took at
+#                   least this long, as shorter ones are noise (default 100)
+#   BENCH_SAVE=1    store this run's results as the new baseline
+CXX=${CXX:-clang++}
+SIZES=${BENCH_SIZES:-"1K 10K 100K 1M"}
+PATTERNS=${BENCH_PATTERNS:-"stream random hotset prodcons falseshare migratory"}
+WRITES=${BENCH_WRITES:-30}
+SHARING=${BENCH_SHARING:-2}
+STREAM_AT=${BENCH_STREAM_AT:-10M}
+BASELINE=${BENCH_BASELINE:-bench_baseline.txt}
+TOLERANCE=${BENCH_TOLERANCE:-10}
+MIN_MS=${BENCH_MIN_MS:-100}
+OUTPUT=bench_output.txt
+
+# Expand a K/M/G suffixed count as trace_gen does
+count_of() {
+    local n=${1%[KkMmGgBb]}
+    case $1 in
+        *[Kk]) echo $((n * 1000)) ;;
+        *[Mm]) echo $((n * 1000000)) ;;
+        *[GgBb]) echo $((n * 1000000000)) ;;
+        *) echo $1 ;;
+    esac
+}
+
+$CXX -w -O2 -pthread cache.cpp -o ./L1simulate_bench || exit 1
+$CXX -w -O2 trace_gen.cpp -o ./trace_gen || exit 1
+
+# Golden correctness checks, using the same arguments as run.sh
+failed=0
+for i in 1 2 3 4 5 6 7 8 9; do
+    [ -f traces/app${i}_proc0.trace ] || continue
+    args="-t app$i"
+    [ $i -eq 4 ] && args="$args -s 0 -E 1"
+    if ! ./L1simulate_bench $args | diff -q - outputs/output$i.txt >/dev/null; then
+        echo "FAIL: app$i does not match outputs/output$i.txt"
+        failed=1
+    fi
+done
+
+# A run restored from a mid-run checkpoint must match an uninterrupted one
+checkpoint=$(mktemp)
+./L1simulate_bench -t app7 -c $checkpoint -k 300 >/dev/null
+if ! ./L1simulate_bench -t app7 -r $checkpoint | diff -q - outputs/output7.txt >/dev/null; then
+    echo "FAIL: app7 restored from cycle 300 does not match outputs/output7.txt"
+    failed=1
+fi
+rm -f $checkpoint
+
+# Streaming must match loading the traces, both per core (-S) and as one
+# core-tagged stream on stdin (-t -, whose Trace Prefix line reads "-")
+if ! ./L1simulate_bench -S -t app7 | diff -q - outputs/output7.txt >/dev/null; then
+    echo "FAIL: app7 streamed with -S does not match outputs/output7.txt"
+    failed=1
+fi
+streamed=$(mktemp)
+for c in 0 1 2 3; do
+    awk -v c=$c '{ print c, $0 }' traces/app7_proc$c.trace
+done | ./L1simulate_bench -t - | grep -v "Trace Prefix" > $streamed
+if ! grep -v "Trace Prefix" outputs/output7.txt | diff -q - $streamed >/dev/null; then
+    echo "FAIL: app7 streamed with -t - does not match outputs/output7.txt"
+    failed=1
+fi
+rm -f $streamed
+[ $failed -eq 0 ] || exit 1
+echo "Golden outputs: OK"
+
+mkdir -p traces/bench
+printf "%-11s %6s %12s %14s %10s %10s %10s %10s %10s\n" pattern size accesses "accesses/s" ns/access "sim ms" \
+    "load KB" "sim KB" "report KB" | tee $OUTPUT
+for pattern in $PATTERNS; do
+    for size in $SIZES; do
+        prefix=bench/${pattern}_${size}
+        ./trace_gen -p $pattern -n $size -w $WRITES -d $SHARING -o $prefix || exit 1
+        stream=""
+        [ $(count_of $size) -ge $(count_of $STREAM_AT) ] && stream="-S"
+        ./L1simulate_bench $stream -t $prefix -p 2>&1 >/dev/null | awk -v p=$pattern -v s=$size '
+            /simulated accesses/ { acc = $NF }
+            /accesses per second/ { aps = $NF }
+            /ns per access/ { ns = $NF }
+            /simulate time/ { ms = $NF }
+            /load peak RSS/ { load = $NF }
+            /simulate peak RSS/ { sim = $NF }
+            /report peak RSS/ { rep = $NF }
+            END { printf "%-11s %6s %12s %14s %10s %10s %10s %10s %10s\n", p, s, acc, aps, ns, ms, load, sim, rep }' | tee -a $OUTPUT
+        rm -f traces/${prefix}_proc*.trace
+    done
+done
+
+regressed=0
+if [ -f "$BASELINE" ]; then
+    # Join on pattern and size, comparing ns/access
+    awk -v tol=$TOLERANCE -v min_ms=$MIN_MS '
+        FNR == 1 { next }
+        NR == FNR { base[$1 " " $2] = $5; base_ms[$1 " " $2] = $6; next }
+        ($1 " " $2) in base && base_ms[$1 " " $2] >= min_ms {
+            change = ($5 - base[$1 " " $2]) * 100.0 / base[$1 " " $2]
+            status = change > tol ? "REGRESSION" : "ok"
+            printf "%-11s %6s %10s -> %10s ns/access (%+.1f%%) %s\n", $1, $2, base[$1 " " $2], $5, change, status
+            if (change > tol) failed = 1
+        }
+        END { exit failed }' "$BASELINE" $OUTPUT || regressed=1
+    [ $regressed -eq 0 ] && echo "No regression beyond ${TOLERANCE}% against $BASELINE" \
+        || echo "FAIL: slower than $BASELINE by more than ${TOLERANCE}%"
+else
+    echo "No baseline at $BASELINE; run with BENCH_SAVE=1 to create one"
+fi
+
+if [ "$BENCH_SAVE" = "1" ]; then
+    cp $OUTPUT "$BASELINE"
+    echo "Saved results as $BASELINE"
+fi
+exit $regressed
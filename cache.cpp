@@ -7,6 +7,13 @@
 #include <bitset>
 #include <getopt.h>
 #include <climits>
+#include <cstring>
+#include <chrono>
+#include <sys/resource.h>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <deque>
 
 using namespace std;
 
@@ -16,18 +23,244 @@ enum miss_or_hit {HIT, MISS};
 
 using CacheLineMeta = tuple<int, CacheState, int>;
 
+// Checkpoint file header: magic + format version. Fields are stored in host
+// byte order, so a checkpoint is only portable between identical builds.
+const char CHECKPOINT_MAGIC[8] = {'M', 'E', 'S', 'I', 'C', 'K', 'P', 'T'};
+const int CHECKPOINT_VERSION = 2;
+
+template <typename T>
+void write_pod(ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read_pod(istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+void write_string(ostream& out, const string& value) {
+    write_pod(out, (int)value.size());
+    out.write(value.data(), value.size());
+}
+
+bool read_string(istream& in, string& value) {
+    int length;
+    if (!read_pod(in, length) || length < 0) return false;
+    value.assign(length, '\0');
+    return static_cast<bool>(in.read(&value[0], length));
+}
+
 struct Statistics {
-    int instructions = 0;
-    int reads = 0;
-    int writes = 0;
-    int execution_cycles = 0;
-    int idle_cycles = 0;
-    int cache_misses = 0;
+    long long instructions = 0;
+    long long reads = 0;
+    long long writes = 0;
+    long long execution_cycles = 0;
+    long long idle_cycles = 0;
+    long long cache_misses = 0;
     float cache_miss_rate = 0.0;
-    int cache_evictions = 0;
-    int write_back = 0;
-    int bus_invalidations = 0;
-    int data_traffic_in_bytes = 0;
+    long long cache_evictions = 0;
+    long long write_back = 0;
+    long long bus_invalidations = 0;
+    long long data_traffic_in_bytes = 0;
+};
+
+// Per-core ring capacity used when streaming traces (-S or -t -)
+const size_t STREAM_RING_CAPACITY = 1 << 16;
+
+// Parse one "R 0x1f00" access, normalising the address to 8 hex digits
+bool parse_access(istream& in, pair<operation, string>& access) {
+    char op_char;
+    string hex_address;
+    if (!(in >> op_char >> hex_address) || (op_char != 'R' && op_char != 'W') ||
+        hex_address.size() < 3 || hex_address.compare(0, 2, "0x") != 0) {
+        return false;
+    }
+    hex_address = hex_address.substr(2); // Remove "0x" prefix
+    if (hex_address.length() < 8) {
+        hex_address = string(8 - hex_address.length(), '0') + hex_address;
+    }
+    access = {(op_char == 'R') ? operation::R : operation::W, hex_address};
+    return true;
+}
+
+bool is_blank(const string& line) {
+    return line.find_first_not_of(" \t\r") == string::npos;
+}
+
+// Bounded lock-free single-producer/single-consumer ring buffer
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) : slots(capacity + 1) {}
+
+    bool try_push(const T& value) {
+        size_t tail = tail_index.load(memory_order_relaxed);
+        size_t next = (tail + 1) % slots.size();
+        if (next == head_index.load(memory_order_acquire)) {
+            return false;
+        }
+        slots[tail] = value;
+        tail_index.store(next, memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& value) {
+        size_t head = head_index.load(memory_order_relaxed);
+        if (head == tail_index.load(memory_order_acquire)) {
+            return false;
+        }
+        value = move(slots[head]);
+        head_index.store((head + 1) % slots.size(), memory_order_release);
+        return true;
+    }
+
+private:
+    vector<T> slots;
+    atomic<size_t> head_index{0};
+    atomic<size_t> tail_index{0};
+};
+
+// Feeds each core's accesses from a reader thread through a bounded ring, so
+// traces can be simulated while they are being produced (e.g. from FIFOs).
+// A full ring stops the reader, which in turn blocks the writer of the pipe;
+// an empty ring stalls the simulation until the core's next access arrives.
+// In a multiplexed stream the access the simulation waits for may sit behind
+// a full ring; only then does the reader read ahead, parking the records of
+// full rings in an overflow queue.
+class TraceStreams {
+public:
+    TraceStreams(int num_cores, size_t capacity) {
+        for (int i = 0; i < num_cores; i++) {
+            rings.emplace_back(new SpscRing<pair<operation, string>>(capacity));
+            finished.emplace_back(new atomic<bool>(false));
+        }
+    }
+
+    // Readers use the rings, so stop them before those are freed. A reader
+    // blocked reading an idle pipe returns once the writer writes or closes it.
+    ~TraceStreams() {
+        stopping.store(true, memory_order_release);
+        join();
+    }
+
+    // One reader thread per core, each reading its own file or FIFO
+    void start_files(const vector<string>& paths) {
+        for (int core = 0; core < (int)paths.size(); core++) {
+            readers.emplace_back([this, core, path = paths[core]]() {
+                ifstream file(path);
+                if (!file.is_open()) {
+                    cerr << "Error: Could not open file " << path << endl;
+                } else {
+                    string line;
+                    pair<operation, string> access;
+                    while (!stopping.load(memory_order_acquire) && getline(file, line)) {
+                        stringstream ss(line);
+                        if (parse_access(ss, access)) {
+                            push(core, access);
+                        } else if (!is_blank(line)) {
+                            cerr << "Error: Malformed trace line in " << path << ": " << line << endl;
+                        }
+                    }
+                }
+                finished[core]->store(true, memory_order_release);
+            });
+        }
+    }
+
+    // A single reader demultiplexing "<core> R 0x1f00" records from stdin
+    void start_multiplexed() {
+        multiplexed = true;
+        readers.emplace_back([this]() {
+            vector<deque<pair<operation, string>>> overflow(rings.size());
+            string line;
+            pair<operation, string> access;
+            int core;
+            while (!stopping.load(memory_order_acquire) && getline(cin, line)) {
+                stringstream ss(line);
+                if (!(ss >> core) || core < 0 || core >= (int)rings.size() || !parse_access(ss, access)) {
+                    if (!is_blank(line)) cerr << "Error: Malformed stream record: " << line << endl;
+                    continue;
+                }
+                overflow[core].push_back(access);
+                // Keep reading only while the simulation waits on a core whose
+                // next record has not been read yet; otherwise apply backpressure
+                for (int spins = 0; !flush_overflow(overflow) && !stopping.load(memory_order_acquire); spins++) {
+                    int starving = starving_core.load(memory_order_acquire);
+                    if (starving >= 0 && overflow[starving].empty()) break;
+                    backoff(spins);
+                }
+            }
+            // A core ends once its parked records are delivered, so the
+            // simulation can finish it while other cores still drain
+            vector<bool> done(rings.size(), false);
+            for (int spins = 0, remaining = rings.size(); remaining > 0 && !stopping.load(memory_order_acquire); spins++) {
+                flush_overflow(overflow);
+                for (int i = 0; i < (int)rings.size(); i++) {
+                    if (!done[i] && overflow[i].empty()) {
+                        finished[i]->store(true, memory_order_release);
+                        done[i] = true;
+                        remaining--;
+                    }
+                }
+                if (remaining > 0) backoff(spins);
+            }
+        });
+    }
+
+    // Next access of a core, waiting for it if needed; false once the stream has ended
+    bool next(int core, pair<operation, string>& access) {
+        bool found = true;
+        for (int spins = 0; !rings[core]->try_pop(access); spins++) {
+            if (finished[core]->load(memory_order_acquire)) {
+                found = rings[core]->try_pop(access);
+                break;
+            }
+            if (multiplexed) starving_core.store(core, memory_order_release);
+            backoff(spins);
+        }
+        if (multiplexed) starving_core.store(-1, memory_order_release);
+        return found;
+    }
+
+    void join() {
+        for (auto& reader : readers) {
+            if (reader.joinable()) reader.join();
+        }
+    }
+
+private:
+    vector<unique_ptr<SpscRing<pair<operation, string>>>> rings;
+    vector<unique_ptr<atomic<bool>>> finished;
+    bool multiplexed = false;
+    atomic<int> starving_core{-1};          // Core the simulation waits on (multiplexed only)
+    atomic<bool> stopping{false};           // Set on destruction to end the readers early
+    vector<thread> readers;
+
+    void push(int core, const pair<operation, string>& access) {
+        for (int spins = 0; !rings[core]->try_push(access) && !stopping.load(memory_order_acquire); spins++) {
+            backoff(spins);
+        }
+    }
+
+    // Move parked records into their rings in order; true once nothing is parked
+    bool flush_overflow(vector<deque<pair<operation, string>>>& overflow) {
+        bool empty = true;
+        for (int i = 0; i < (int)overflow.size(); i++) {
+            while (!overflow[i].empty() && rings[i]->try_push(overflow[i].front())) {
+                overflow[i].pop_front();
+            }
+            empty = empty && overflow[i].empty();
+        }
+        return empty;
+    }
+
+    static void backoff(int spins) {
+        if (spins < 64) {
+            this_thread::yield();
+        } else {
+            this_thread::sleep_for(chrono::microseconds(50));
+        }
+    }
 };
 
 struct Bits {
@@ -45,16 +278,44 @@ struct Bus {
     bool invalidation = false;
     CacheState set_state;
 
-    int transactions=0;
-    int BusRd = 0;
-    int BusRdX = 0;
-    int BusInv = 0;
-    int traffic=0;
+    long long transactions=0;
+    long long BusRd = 0;
+    long long BusRdX = 0;
+    long long BusInv = 0;
+    long long traffic=0;
 
     // Extend Bus struct to support multi-step transactions
     enum TransactionType { NONE, CACHE_TO_CACHE, WRITE_BACK };
     TransactionType transaction_type = NONE;
     int pending_writeback_cache = -1; // which cache needs to write back after transfer
+
+    // Save/restore every field, including any in-flight transaction
+    void save_state(ostream& out) const {
+        write_pod(out, busy);
+        write_pod(out, cycle_remaining);
+        write_pod(out, source_cache);
+        write_pod(out, target_cache);
+        write_string(out, address);
+        write_pod(out, invalidation);
+        write_pod(out, set_state);
+        write_pod(out, transactions);
+        write_pod(out, BusRd);
+        write_pod(out, BusRdX);
+        write_pod(out, BusInv);
+        write_pod(out, traffic);
+        write_pod(out, transaction_type);
+        write_pod(out, pending_writeback_cache);
+    }
+
+    bool load_state(istream& in) {
+        return read_pod(in, busy) && read_pod(in, cycle_remaining) &&
+               read_pod(in, source_cache) && read_pod(in, target_cache) &&
+               read_string(in, address) && read_pod(in, invalidation) &&
+               read_pod(in, set_state) && read_pod(in, transactions) &&
+               read_pod(in, BusRd) && read_pod(in, BusRdX) &&
+               read_pod(in, BusInv) && read_pod(in, traffic) &&
+               read_pod(in, transaction_type) && read_pod(in, pending_writeback_cache);
+    }
 };
 
 class Cache {
@@ -73,9 +334,12 @@ public:
     int waiting_time = 0;
     int cache_id = -1;
     vector<pair<operation, string>> trace_data;
+    TraceStreams* streams = nullptr;        // Set when the trace is streamed instead of loaded
+    pair<operation, string> streamed_access;
+    int streamed_count = 0;                 // Number of accesses taken from the stream so far
 
     // Constructor
-    Cache(int set_bits, int num_ways, int cache_line_bits, string filepath, int id) {
+    Cache(int set_bits, int num_ways, int cache_line_bits, string filepath, int id, TraceStreams* streams = nullptr) {
         num_sets = (1 << set_bits);
         this->set_bits = set_bits;
         associativity = num_ways;
@@ -84,7 +348,30 @@ public:
         cache_id = id;
         tag_array.resize(num_sets, vector<CacheLineMeta>(num_ways, {-1, CacheState::I, -1}));
         data_array.resize(num_sets, vector<vector<int>>(num_ways, vector<int>(blocksize_in_bytes, 0)));
-        process_trace_file(filepath, trace_data);
+        this->streams = streams;
+        if (!streams) {
+            process_trace_file(filepath, trace_data);
+        }
+    }
+
+    // Whether an access remains at current_instruction_number. When streaming,
+    // this waits for the access to arrive and skips any already-simulated prefix
+    // (e.g. after restoring a checkpoint).
+    bool has_instruction() {
+        if (!streams) {
+            return current_instruction_number < trace_data.size();
+        }
+        while (streamed_count <= current_instruction_number) {
+            if (!streams->next(cache_id, streamed_access)) {
+                return false;
+            }
+            streamed_count++;
+        }
+        return true;
+    }
+
+    const pair<operation, string>& current_instruction() const {
+        return streams ? streamed_access : trace_data[current_instruction_number];
     }
 
     // Helper: pretty-print the state
@@ -110,6 +397,36 @@ public:
         }
     }
 
+    // Save/restore the simulation state of this cache. The trace itself is
+    // not stored; it is reloaded from the trace files on restore.
+    void save_state(ostream& out) const {
+        for (auto& set : tag_array) {
+            for (auto& [tag, state, ts] : set) {
+                write_pod(out, tag);
+                write_pod(out, state);
+                write_pod(out, ts);
+            }
+        }
+        write_pod(out, stats);
+        write_pod(out, stall_flag);
+        write_pod(out, current_instruction_number);
+        write_pod(out, is_active);
+        write_pod(out, waiting_time);
+    }
+
+    bool load_state(istream& in) {
+        for (auto& set : tag_array) {
+            for (auto& [tag, state, ts] : set) {
+                if (!read_pod(in, tag) || !read_pod(in, state) || !read_pod(in, ts)) {
+                    return false;
+                }
+            }
+        }
+        return read_pod(in, stats) && read_pod(in, stall_flag) &&
+               read_pod(in, current_instruction_number) && read_pod(in, is_active) &&
+               read_pod(in, waiting_time);
+    }
+
     void process_trace_file(string file_path, vector<pair<operation, string>>& trace_data) {
         ifstream file(file_path);
         if (!file.is_open()) {
@@ -118,20 +435,14 @@ public:
         }
 
         string line;
+        pair<operation, string> access;
         while (getline(file, line)) {
             stringstream ss(line);
-            char op_char;
-            string hex_address;
-
-            ss >> op_char >> hex_address;
-
-            operation op = (op_char == 'R') ? operation::R : operation::W;
-            hex_address = hex_address.substr(2); // Remove "0x" prefix
-            if (hex_address.length() < 8) {
-                hex_address = string(8 - hex_address.length(), '0') + hex_address;
+            if (parse_access(ss, access)) {
+                trace_data.push_back(access);
+            } else if (!is_blank(line)) {
+                cerr << "Error: Malformed trace line in " << file_path << ": " << line << endl;
             }
-
-            trace_data.emplace_back(op, hex_address);
         }
 
         file.close();
@@ -513,15 +824,146 @@ public:
 
 };
 
+// Wall time and peak resident set size of one simulator phase (-p)
+struct PhaseProfile {
+    string name;
+    double seconds = 0.0;
+    long peak_rss_kb = 0;
+};
+
+using ProfileClock = chrono::steady_clock;
+
+// Resets the kernel's RSS high-water mark (Linux), so that the peak read at
+// the end of a phase covers that phase only
+ProfileClock::time_point begin_phase(bool profile) {
+    if (profile) {
+        ofstream clear_refs("/proc/self/clear_refs");
+        clear_refs << "5";
+    }
+    return ProfileClock::now();
+}
+
+PhaseProfile end_phase(const string& name, ProfileClock::time_point start) {
+    PhaseProfile phase;
+    phase.name = name;
+    phase.seconds = chrono::duration<double>(ProfileClock::now() - start).count();
+
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            phase.peak_rss_kb = stol(line.substr(6));
+            return phase;
+        }
+    }
+    // Without /proc, fall back to the peak over the whole process lifetime
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        phase.peak_rss_kb = usage.ru_maxrss;
+    }
+    return phase;
+}
+
+// Printed to stderr so that the regular report on stdout stays unchanged
+void print_profile(const vector<PhaseProfile>& phases, long long accesses) {
+    double simulate_seconds = phases[1].seconds;
+    cerr << "==================== PERFORMANCE PROFILE ========================" << endl;
+    cerr << "01. simulated accesses:                " << accesses << endl;
+    cerr << "02. accesses per second:               " << fixed << setprecision(0)
+         << (simulate_seconds > 0 ? accesses / simulate_seconds : 0.0) << endl;
+    cerr << "03. ns per access:                     " << fixed << setprecision(2)
+         << (accesses > 0 ? simulate_seconds * 1e9 / accesses : 0.0) << endl;
+    int line = 4;
+    for (auto& phase : phases) {
+        cerr << setw(2) << setfill('0') << line++ << setfill(' ') << ". " << left << setw(35)
+             << (phase.name + " time (ms):") << right << fixed << setprecision(3) << phase.seconds * 1e3 << endl;
+        cerr << setw(2) << setfill('0') << line++ << setfill(' ') << ". " << left << setw(35)
+             << (phase.name + " peak RSS (KB):") << right << phase.peak_rss_kb << endl;
+    }
+}
+
+bool save_checkpoint(const string& path, const string& tracefile, int s, int E, int b,
+                     long long cycle, const Bus& bus, const vector<Cache*>& caches) {
+    ofstream out(path, ios::binary);
+    if (!out.is_open()) {
+        cerr << "Error: Could not open checkpoint file " << path << endl;
+        return false;
+    }
+    out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    write_pod(out, CHECKPOINT_VERSION);
+    write_string(out, tracefile);
+    write_pod(out, s);
+    write_pod(out, E);
+    write_pod(out, b);
+    write_pod(out, (int)caches.size());
+    write_pod(out, cycle);
+    bus.save_state(out);
+    for (auto& cache : caches) {
+        cache->save_state(out);
+    }
+    if (!out) {
+        cerr << "Error: Failed writing checkpoint file " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+bool load_checkpoint(const string& path, const string& tracefile, int s, int E, int b,
+                     long long& cycle, Bus& bus, vector<Cache*>& caches) {
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) {
+        cerr << "Error: Could not open checkpoint file " << path << endl;
+        return false;
+    }
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    int version;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 ||
+        !read_pod(in, version) || version != CHECKPOINT_VERSION) {
+        cerr << "Error: " << path << " is not a valid checkpoint file" << endl;
+        return false;
+    }
+
+    // The checkpoint is only meaningful for the same trace and cache geometry
+    string saved_tracefile;
+    int saved_s, saved_E, saved_b, saved_num_caches;
+    if (!read_string(in, saved_tracefile) || !read_pod(in, saved_s) || !read_pod(in, saved_E) ||
+        !read_pod(in, saved_b) || !read_pod(in, saved_num_caches)) {
+        cerr << "Error: Truncated checkpoint file " << path << endl;
+        return false;
+    }
+    if (saved_tracefile != tracefile || saved_s != s || saved_E != E || saved_b != b ||
+        saved_num_caches != (int)caches.size()) {
+        cerr << "Error: Checkpoint " << path << " was taken with -t " << saved_tracefile
+             << " -s " << saved_s << " -E " << saved_E << " -b " << saved_b
+             << ", which does not match the current configuration" << endl;
+        return false;
+    }
+
+    bool ok = read_pod(in, cycle) && bus.load_state(in);
+    for (auto& cache : caches) {
+        ok = ok && cache->load_state(in);
+    }
+    if (!ok) {
+        cerr << "Error: Truncated checkpoint file " << path << endl;
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     string tracefile = "default_trace.txt"; // Default trace file
     int s = 6;                             // Default set index bits
     int E = 2;                             // Default associativity
     int b = 5;                             // Default block bits
     string outfilename = "default_output.txt"; // Default output file
+    string checkpoint_file;                // Checkpoint to write (-c)
+    long long checkpoint_cycle = -1;       // Cycle at which to write it (-k)
+    string restore_file;                   // Checkpoint to resume from (-r)
+    bool profile = false;                  // Print per-phase timings (-p)
+    bool stream_input = false;             // Stream traces through reader threads (-S)
 
     int opt;
-    while ((opt = getopt(argc, argv, "t:s:E:b:o:h")) != -1) {
+    while ((opt = getopt(argc, argv, "t:s:E:b:o:c:k:r:pSh")) != -1) {
         switch (opt) {
             case 't':
                 tracefile = optarg;
@@ -538,36 +980,97 @@ int main(int argc, char* argv[]) {
             case 'o':
                 outfilename = optarg;
                 break;
+            case 'c':
+                checkpoint_file = optarg;
+                break;
+            case 'k':
+                checkpoint_cycle = stoll(optarg);
+                break;
+            case 'r':
+                restore_file = optarg;
+                break;
+            case 'p':
+                profile = true;
+                break;
+            case 'S':
+                stream_input = true;
+                break;
             case 'h':
-                cout << "Usage: " << argv[0] << " -t <tracefile> -s <s> -E <E> -b <b> -o <outfilename> -h" << endl;
+                cout << "Usage: " << argv[0] << " -t <tracefile> -s <s> -E <E> -b <b> -o <outfilename> [-c <checkpoint> -k <cycle>] [-r <checkpoint>] -p -S -h" << endl;
                 cout << "  -t <tracefile>: name of parallel application (e.g. app1) whose 4 traces are to be used in simulation" << endl;
+                cout << "                  or - to stream \"<core> R|W <address>\" records from stdin" << endl;
                 cout << "  -s <s>: number of set index bits (number of sets in the cache = S = 2^s)" << endl;
                 cout << "  -E <E>: associativity (number of cache lines per set)" << endl;
                 cout << "  -b <b>: number of block bits (block size = B = 2^b)" << endl;
                 cout << "  -o <outfilename>: logs output in file for plotting etc." << endl;
+                cout << "  -c <checkpoint>: writes the full simulator state to this file at the cycle given by -k" << endl;
+                cout << "  -k <cycle>: cycle at which the checkpoint is written" << endl;
+                cout << "  -r <checkpoint>: resumes the simulation from a checkpoint taken with the same -t/-s/-E/-b" << endl;
+                cout << "  -p: prints throughput, time and peak RSS per phase (load, simulate, report) to stderr" << endl;
+                cout << "  -S: streams the traces while simulating instead of loading them first (works with FIFOs)" << endl;
                 cout << "  -h: prints this help" << endl;
                 return 0;
             default:
-                cerr << "Usage: " << argv[0] << " -t <tracefile> -s <s> -E <E> -b <b> -o <outfilename> -h" << endl;
+                cerr << "Usage: " << argv[0] << " -t <tracefile> -s <s> -E <E> -b <b> -o <outfilename> [-c <checkpoint> -k <cycle>] [-r <checkpoint>] -p -S -h" << endl;
                 return 1;
         }
     }
 
+    if (!checkpoint_file.empty() && checkpoint_cycle <= 0) {
+        cerr << "Error: -c requires a positive checkpoint cycle given with -k" << endl;
+        return 1;
+    }
+    if (checkpoint_file.empty() && checkpoint_cycle != -1) {
+        cerr << "Error: -k requires a checkpoint file given with -c" << endl;
+        return 1;
+    }
+
+    vector<PhaseProfile> phases;
+    ProfileClock::time_point phase_start = begin_phase(profile);
+
     // Construct the trace file paths based on the tracefile name
     string trace_path_0 = "traces/" + tracefile + "_proc0.trace";
     string trace_path_1 = "traces/" + tracefile + "_proc1.trace";
     string trace_path_2 = "traces/" + tracefile + "_proc2.trace";
     string trace_path_3 = "traces/" + tracefile + "_proc3.trace";
 
-    Cache cache0(s, E, b, trace_path_0, 0);
-    Cache cache1(s, E, b, trace_path_1, 1);
-    Cache cache2(s, E, b, trace_path_2, 2);
-    Cache cache3(s, E, b, trace_path_3, 3);
+    // Reader threads start only after the checkpoint (if any) has been loaded
+    unique_ptr<TraceStreams> streams;
+    if (tracefile == "-" || stream_input) {
+        streams.reset(new TraceStreams(4, STREAM_RING_CAPACITY));
+    }
+
+    Cache cache0(s, E, b, trace_path_0, 0, streams.get());
+    Cache cache1(s, E, b, trace_path_1, 1, streams.get());
+    Cache cache2(s, E, b, trace_path_2, 2, streams.get());
+    Cache cache3(s, E, b, trace_path_3, 3, streams.get());
     
     vector<Cache*> caches = {&cache0, &cache1, &cache2, &cache3};
     Bus bus;
-    int cycle = 0;
+    long long cycle = 0;
     bool all_done = false;
+
+    if (!restore_file.empty()) {
+        if (!load_checkpoint(restore_file, tracefile, s, E, b, cycle, bus, caches)) {
+            return 1;
+        }
+        if (!checkpoint_file.empty() && checkpoint_cycle <= cycle) {
+            cerr << "Warning: checkpoint cycle " << checkpoint_cycle << " is not after restored cycle " << cycle << endl;
+        }
+    }
+
+    if (tracefile == "-") {
+        streams->start_multiplexed();
+    } else if (streams) {
+        streams->start_files({trace_path_0, trace_path_1, trace_path_2, trace_path_3});
+    }
+
+    long long start_instructions = 0;
+    for (auto& cache : caches) {
+        start_instructions += cache->current_instruction_number;
+    }
+    phases.push_back(end_phase("load", phase_start));
+    phase_start = begin_phase(profile);
     
     while (!all_done) {
         cycle++;
@@ -595,11 +1098,11 @@ int main(int argc, char* argv[]) {
         for (int i = 0; i < 4; i++) {
             Cache* cache = caches[i];
             // Check if any trace operations remain
-            if (cache->current_instruction_number < cache->trace_data.size()) {
+            if (cache->has_instruction()) {
                 all_done = false;
                 
                 if (cache->is_active) {
-                    auto [op, address] = cache->trace_data[cache->current_instruction_number];
+                    auto [op, address] = cache->current_instruction();
                     Bits bits = cache->parse(address);
                     miss_or_hit result = cache->hit_or_miss(bits);
                     cache->stall_flag = false;
@@ -636,7 +1139,29 @@ int main(int argc, char* argv[]) {
                 }
             }
         }
+
+        // A checkpoint taken after the final cycle could not be resumed, so skip it
+        if (!checkpoint_file.empty() && cycle == checkpoint_cycle && !all_done) {
+            if (!save_checkpoint(checkpoint_file, tracefile, s, E, b, cycle, bus, caches)) {
+                return 1;
+            }
+        }
     }
+
+    if (!checkpoint_file.empty() && checkpoint_cycle >= cycle) {
+        cerr << "Warning: simulation finished in " << cycle << " cycles, before checkpoint cycle " << checkpoint_cycle << endl;
+    }
+
+    if (streams) {
+        streams->join();
+    }
+
+    long long simulated_accesses = -start_instructions;
+    for (auto& cache : caches) {
+        simulated_accesses += cache->current_instruction_number;
+    }
+    phases.push_back(end_phase("simulate", phase_start));
+    phase_start = begin_phase(profile);
     
     // Output statistics to file if requested
     ofstream outfile;
@@ -717,6 +1242,12 @@ int main(int argc, char* argv[]) {
     if (outfile.is_open()) {
         outfile.close();
     }
+
+    if (profile) {
+        cout.flush();
+        phases.push_back(end_phase("report", phase_start));
+        print_profile(phases, simulated_accesses);
+    }
     
     return 0;
 }
\ No newline at end of file
@@ -1,5 +1,5 @@
 #!/bin/bash
-clang++ cache.cpp
+clang++ -pthread cache.cpp
 ./a.out -t app1 > outputs/output1.txt
 ./a.out -t app2 > outputs/output2.txt
 ./a.out -t app3 > outputs/output3.txt
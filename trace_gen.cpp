@@ -0,0 +1,295 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdio>
+#include <cstdint>
+#include <climits>
+#include <memory>
+#include <getopt.h>
+#include <sys/stat.h>
+#include <cerrno>
+
+using namespace std;
+
+const int NUM_CORES = 4;
+
+enum Pattern { STREAM, RANDOM, HOTSET, PRODCONS, FALSESHARE, MIGRATORY };
+
+struct Access {
+    char op;
+    uint32_t address;
+};
+
+struct Config {
+    Pattern pattern = STREAM;
+    long long accesses = 1000;   // Total accesses across all cores
+    int write_percent = 30;      // Share of writes for patterns with a free R/W mix
+    int sharing_degree = 2;      // Number of cores (starting at core 0) touching shared data
+    int block_bits = 5;          // Block size used to lay out blocks
+    uint64_t seed = 1;
+};
+
+// Each core owns a private 16 MB region; shared data lives above them
+const uint32_t REGION_SIZE = 1u << 24;
+const uint32_t SHARED_BASE = NUM_CORES * REGION_SIZE;
+const int HOT_BLOCKS = 64;
+
+// The simulator counts each core's accesses in an int
+const long long MAX_ACCESSES = 1000000000LL;
+
+bool parse_pattern(const string& name, Pattern& pattern) {
+    if (name == "stream") pattern = STREAM;
+    else if (name == "random") pattern = RANDOM;
+    else if (name == "hotset") pattern = HOTSET;
+    else if (name == "prodcons") pattern = PRODCONS;
+    else if (name == "falseshare") pattern = FALSESHARE;
+    else if (name == "migratory") pattern = MIGRATORY;
+    else return false;
+    return true;
+}
+
+// Accepts plain counts and K/M/G (or B for billion) suffixes, e.g. 1K, 10M, 1B
+bool parse_count(const string& text, long long& count) {
+    size_t pos;
+    try {
+        count = stoll(text, &pos);
+    } catch (...) {
+        return false;
+    }
+    if (pos == text.size()) return count > 0;
+    if (pos + 1 != text.size()) return false;
+    long long multiplier;
+    switch (toupper(text[pos])) {
+        case 'K': multiplier = 1000LL; break;
+        case 'M': multiplier = 1000000LL; break;
+        case 'G':
+        case 'B': multiplier = 1000000000LL; break;
+        default: return false;
+    }
+    if (count <= 0 || count > LLONG_MAX / multiplier) return false;
+    count *= multiplier;
+    return true;
+}
+
+class TraceGenerator {
+public:
+    TraceGenerator(const Config& config, int core)
+        : config(config), core(core), rng(config.seed * 1000003ULL + core) {
+        block_size = 1u << config.block_bits;
+        shared = core < config.sharing_degree;
+        base = shared ? SHARED_BASE : core * REGION_SIZE;
+    }
+
+    Access next(long long i) {
+        switch (config.pattern) {
+            case STREAM: {
+                // Sequential word accesses over the region, wrapping around
+                uint32_t offset = (uint32_t)((i * 4) % REGION_SIZE);
+                return {random_op(), base + offset};
+            }
+            case RANDOM:
+                return {random_op(), base + random_word(REGION_SIZE)};
+            case HOTSET: {
+                // 90% of accesses go to a small hot set, the rest to the cold region
+                if (rng() % 10 != 0) {
+                    return {random_op(), base + random_word(HOT_BLOCKS * block_size)};
+                }
+                return {random_op(), base + HOT_BLOCKS * block_size + random_word(REGION_SIZE - HOT_BLOCKS * block_size)};
+            }
+            case PRODCONS: {
+                // Core 0 writes a ring of blocks that the other sharing cores read
+                if (!shared) {
+                    return {random_op(), base + random_word(REGION_SIZE)};
+                }
+                uint32_t offset = (uint32_t)((i % (HOT_BLOCKS * (block_size / 4))) * 4);
+                return {core == 0 ? 'W' : 'R', base + offset};
+            }
+            case FALSESHARE: {
+                // Each sharing core gets its own slice of every block, so cores
+                // never touch the same bytes but always share blocks (block_size >= 4)
+                if (!shared) {
+                    return {random_op(), base + random_word(HOT_BLOCKS * block_size)};
+                }
+                uint32_t block = (uint32_t)(i % HOT_BLOCKS);
+                uint32_t slice = core * (block_size / NUM_CORES);
+                return {random_op(), base + block * block_size + slice};
+            }
+            case MIGRATORY: {
+                // Read-modify-write of objects that migrate between the sharing cores
+                if (i % 2 == 0) {
+                    object = (uint32_t)(rng() % HOT_BLOCKS);
+                }
+                return {i % 2 == 0 ? 'R' : 'W', base + object * block_size};
+            }
+        }
+        return {'R', base};
+    }
+
+private:
+    const Config& config;
+    int core;
+    mt19937_64 rng;
+    uint32_t block_size;
+    bool shared;
+    uint32_t base;
+    uint32_t object = 0;
+
+    char random_op() {
+        return (int)(rng() % 100) < config.write_percent ? 'W' : 'R';
+    }
+
+    uint32_t random_word(uint32_t range) {
+        return (uint32_t)(rng() % (range / 4)) * 4;
+    }
+};
+
+// Creates every missing directory leading up to path (like mkdir -p)
+bool create_parent_dirs(const string& path) {
+    for (size_t slash = path.find('/'); slash != string::npos; slash = path.find('/', slash + 1)) {
+        string dir = path.substr(0, slash);
+        if (!dir.empty() && mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+            cerr << "Error: Could not create directory " << dir << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool write_trace(const string& path, const Config& config, int core, long long count) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        cerr << "Error: Could not open file " << path << endl;
+        return false;
+    }
+
+    TraceGenerator generator(config, core);
+    vector<char> buffer(1 << 20);
+    size_t used = 0;
+    for (long long i = 0; i < count; i++) {
+        if (used + 32 > buffer.size()) {
+            fwrite(buffer.data(), 1, used, file);
+            used = 0;
+        }
+        Access access = generator.next(i);
+        used += snprintf(buffer.data() + used, 32, "%c 0x%x\n", access.op, access.address);
+    }
+    fwrite(buffer.data(), 1, used, file);
+
+    bool ok = !ferror(file);
+    fclose(file);
+    if (!ok) {
+        cerr << "Error: Failed writing file " << path << endl;
+    }
+    return ok;
+}
+
+// Round-robin interleaving of all cores as "<core> R 0x1f00" records, the
+// format the simulator reads from stdin with -t -
+bool write_multiplexed(FILE* file, const Config& config, const vector<long long>& counts) {
+    vector<unique_ptr<TraceGenerator>> generators;
+    for (int core = 0; core < NUM_CORES; core++) {
+        generators.emplace_back(new TraceGenerator(config, core));
+    }
+
+    vector<char> buffer(1 << 20);
+    size_t used = 0;
+    for (long long i = 0; i < counts[0]; i++) {
+        for (int core = 0; core < NUM_CORES && i < counts[core]; core++) {
+            if (used + 32 > buffer.size()) {
+                fwrite(buffer.data(), 1, used, file);
+                used = 0;
+            }
+            Access access = generators[core]->next(i);
+            used += snprintf(buffer.data() + used, 32, "%d %c 0x%x\n", core, access.op, access.address);
+        }
+    }
+    fwrite(buffer.data(), 1, used, file);
+    fflush(file);
+    return !ferror(file);
+}
+
+void print_usage(const char* program, ostream& out) {
+    out << "Usage: " << program << " -p <pattern> -n <accesses> -w <write%> -d <sharing> -b <b> -r <seed> -o <prefix> -h" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    Config config;
+    string prefix;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "p:n:w:d:b:r:o:h")) != -1) {
+        switch (opt) {
+            case 'p':
+                if (!parse_pattern(optarg, config.pattern)) {
+                    cerr << "Error: Unknown pattern " << optarg << endl;
+                    return 1;
+                }
+                break;
+            case 'n':
+                if (!parse_count(optarg, config.accesses) || config.accesses > MAX_ACCESSES) {
+                    cerr << "Error: Invalid access count " << optarg << " (at most 1G)" << endl;
+                    return 1;
+                }
+                break;
+            case 'w':
+                config.write_percent = stoi(optarg);
+                break;
+            case 'd':
+                config.sharing_degree = stoi(optarg);
+                break;
+            case 'b':
+                config.block_bits = stoi(optarg);
+                break;
+            case 'r':
+                config.seed = stoull(optarg);
+                break;
+            case 'o':
+                prefix = optarg;
+                break;
+            case 'h':
+                print_usage(argv[0], cout);
+                cout << "  -p <pattern>: stream, random, hotset, prodcons, falseshare or migratory" << endl;
+                cout << "  -n <accesses>: total accesses over all 4 cores, with optional K/M/G suffix, at most 1G" << endl;
+                cout << "  -w <write%>: percentage of writes (stream, random, hotset, falseshare)" << endl;
+                cout << "  -d <sharing>: number of cores, starting at core 0, that touch shared data (1-4)" << endl;
+                cout << "  -b <b>: number of block bits used to lay out blocks (must match the simulator's -b)" << endl;
+                cout << "  -r <seed>: random seed" << endl;
+                cout << "  -o <prefix>: writes traces/<prefix>_proc0..3.trace (creating directories), or - for one multiplexed stream on stdout" << endl;
+                cout << "  -h: prints this help" << endl;
+                return 0;
+            default:
+                print_usage(argv[0], cerr);
+                return 1;
+        }
+    }
+
+    if (prefix.empty()) {
+        cerr << "Error: An output prefix must be given with -o" << endl;
+        return 1;
+    }
+    if (config.write_percent < 0 || config.write_percent > 100 ||
+        config.sharing_degree < 1 || config.sharing_degree > NUM_CORES ||
+        config.block_bits < 2 || config.block_bits > 16) {
+        cerr << "Error: -w must be 0-100, -d 1-" << NUM_CORES << " and -b 2-16" << endl;
+        return 1;
+    }
+
+    // Spread the remainder over the first cores so the total is exact
+    vector<long long> counts;
+    for (int core = 0; core < NUM_CORES; core++) {
+        counts.push_back(config.accesses / NUM_CORES + (core < config.accesses % NUM_CORES ? 1 : 0));
+    }
+
+    if (prefix == "-") {
+        return write_multiplexed(stdout, config, counts) ? 0 : 1;
+    }
+    for (int core = 0; core < NUM_CORES; core++) {
+        string path = "traces/" + prefix + "_proc" + to_string(core) + ".trace";
+        if (!create_parent_dirs(path) || !write_trace(path, config, core, counts[core])) {
+            return 1;
+        }
+    }
+    return 0;
+}